@@ -4,15 +4,22 @@
 #include "hittable.h"
 #include "material.h"
 
+class static_scene;
+
+// Pixel rectangle [start_x, end_x) x [start_y, end_y) covered by one tile.
+struct tile_rect {
+    int start_x, start_y, end_x, end_y;
+};
+
 class camera {
   public:
     double aspect_ratio = 1.0;  // Ratio of image width over height
-    unsigned short image_width  = 100;  // Rendered image width in pixel count
-    unsigned short image_height;   // Rendered image height
-    unsigned short samples_per_pixel = 10; // Count of random samples for each pixel
-    unsigned short max_depth = 10;
-    unsigned short block_size_y = 32;
-    unsigned short block_size_x = 32;
+    int image_width  = 100;  // Rendered image width in pixel count
+    int image_height;   // Rendered image height
+    int samples_per_pixel = 10; // Count of random samples for each pixel
+    int max_depth = 10;
+    int block_size_y = 32; // Tile height, edge tiles are clipped to the image
+    int block_size_x = 32; // Tile width, edge tiles are clipped to the image
 
     double vfov = 90; // Vertical field of view(view angle)
     point3 lookfrom = point3(0, 0, 0); // Point camera is looking from
@@ -22,10 +29,17 @@ class camera {
     double defocus_angle = 0; // Variation of angle of rays through each pixel
     double focus_dist = 10; // Distance from camera lookfrom point to plane of perfect focus
 
-    void render(const hittable& world, std::vector<color>& data, const int sub_x, const int sub_y);
+    // Renders one tile. Instantiated for the virtual `hittable` scene and for `static_scene`.
+    template <typename World>
+    void render(const World& world, std::vector<color>& data, const int sub_x, const int sub_y);
+    // Adds one unscaled sample per pixel of the tile to `accum`, used by the progressive preview.
+    void render_pass(const hittable& world, std::vector<color>& accum, const int sub_x, const int sub_y);
+    // Pixels of tile (sub_x, sub_y). Tiles on the right and bottom edges are clipped to the image.
+    tile_rect tile_bounds(const int sub_x, const int sub_y) const;
     void initialize();
 
   private:
+    friend class wavefront_integrator;
    
     double pixel_samples_scale; // Color scale factor for a sum of pixel samples
     point3 center;         // Camera center
@@ -38,6 +52,8 @@ class camera {
 
 
     color ray_color(const ray& r, int depth, const hittable& world) const;
+    color ray_color(const ray& r, int depth, const static_scene& world) const;
+    color background(const ray& r) const;
 
     ray get_ray(int i, int j) const;
 
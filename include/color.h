@@ -4,5 +4,6 @@
 #include "vec3.h"
 using color = vec3;
 inline double linear_to_gamma(double linear_component);
+void color_to_bytes(const color& pixel_colour, unsigned char bytes[3]);
 void write_color(std::ofstream& out, const color& pixel_colour);
 #endif
\ No newline at end of file
@@ -12,25 +12,35 @@ class material {
         }
 };
 
-class lambertian : public material {
+// The concrete materials are final and define scatter in the header, so that code holding
+// them by value (see static_scene.h) gets direct, inlinable calls instead of virtual ones.
+class lambertian final : public material {
     private:
         color albedo;
         
     public:
         lambertian(const color& alb) : albedo(alb){}
-        bool scatter(const ray& ray_in, const hit_record& rec, color& attentuation, ray& scattered) const override;
+        bool scatter(const ray& ray_in, const hit_record& rec, color& attentuation, ray& scattered) const override {
+            return scatter(ray_in, rec.p, rec.normal, rec.front_face, attentuation, scattered);
+        }
+        bool scatter(const ray& ray_in, const point3& p, const vec3& normal, bool front_face,
+                     color& attentuation, ray& scattered) const;
 };
 
-class metal: public material {
+class metal final : public material {
     private:
         color albedo;
         double fuzz;
     public:
         metal(const color& alb, double fz) : albedo(alb), fuzz(fz < 1 ? fz : 1)  {}
-        bool scatter(const ray& r_in, const hit_record& rec, color& attenuation, ray& scattered) const override;
+        bool scatter(const ray& r_in, const hit_record& rec, color& attenuation, ray& scattered) const override {
+            return scatter(r_in, rec.p, rec.normal, rec.front_face, attenuation, scattered);
+        }
+        bool scatter(const ray& r_in, const point3& p, const vec3& normal, bool front_face,
+                     color& attenuation, ray& scattered) const;
 };
 
-class dielectric: public material {
+class dielectric final : public material {
     private:
     /* Refractive index in vacumm or air, or the ratio of the material's refractive index 
         over the refractive index of the enclosing media*/
@@ -44,6 +54,52 @@ class dielectric: public material {
     public:
         dielectric(double ri): refractive_index(ri) {}
 
-        bool scatter(const ray& r_in, const hit_record& rec, color& attenuation, ray& scattered) const override;
+        bool scatter(const ray& r_in, const hit_record& rec, color& attenuation, ray& scattered) const override {
+            return scatter(r_in, rec.p, rec.normal, rec.front_face, attenuation, scattered);
+        }
+        bool scatter(const ray& r_in, const point3& p, const vec3& normal, bool front_face,
+                     color& attenuation, ray& scattered) const;
 };
+
+// Scatter kernels, shared by the virtual and the static dispatch paths.
+inline bool lambertian::scatter(const ray& ray_in, const point3& p, const vec3& normal, bool front_face,
+                                color& attentuation, ray& scattered) const {
+    auto scatter_direction = normal + random_unit_vector();
+
+    // Catch degenerate scatter direction
+    if (scatter_direction.near_zero())
+        scatter_direction = normal;
+    scattered = ray(p, scatter_direction);
+    attentuation = albedo;
+    return true;
+}
+
+inline bool metal::scatter(const ray& r_in, const point3& p, const vec3& normal, bool front_face,
+                           color& attenuation, ray& scattered) const {
+    vec3 reflected = reflect(r_in.direction(), normal);
+    reflected = unit_vector(reflected) + (fuzz * random_unit_vector());
+    scattered = ray(p, reflected);
+    attenuation = albedo;
+    return (dot(scattered.direction(), normal) > 0);
+}
+
+inline bool dielectric::scatter(const ray& r_in, const point3& p, const vec3& normal, bool front_face,
+                                color& attenuation, ray& scattered) const {
+    attenuation = color(1.0, 1.0, 1.0);
+    double ri = front_face ? (1.0/refractive_index) : refractive_index;
+
+    vec3 unit_direction = unit_vector(r_in.direction());
+    double cost_theta = std::fmin(dot(-unit_direction, normal), 1.0);
+    double sin_theta = std::sqrt(1.0 - cost_theta*cost_theta);
+
+    bool cannot_refract = ri*sin_theta > 1.0;
+    vec3 direction;
+    if (cannot_refract || reflectance(cost_theta, ri) > random_double())
+        direction = reflect(unit_direction, normal);
+    else
+        direction = refract(unit_direction, normal, ri);
+
+    scattered = ray(p, direction);
+    return true;
+}
 #endif
\ No newline at end of file
@@ -0,0 +1,38 @@
+#ifndef PREVIEW_H
+#define PREVIEW_H
+
+#include "camera.h"
+#include "hittable.h"
+#include <string>
+
+// Settings for the progressive preview. Every pass renders one sample per pixel over all
+// tiles. Once every tile has a sample, the running average is written to `output_path`
+// every `publish_interval_ms` from a separate thread while the workers keep rendering.
+struct preview_settings {
+    int passes = 16;
+    int num_threads = 1;
+    int publish_interval_ms = 250;
+    std::string output_path = "preview.ppm";
+};
+
+struct preview_stats {
+    double time_to_first_image = 0; // Seconds until the first framebuffer was published
+    double total_time = 0;          // Seconds until the workers finished the last pass
+    double publish_time = 0;        // Seconds spent publishing, overlapped with rendering
+    int passes = 0;
+    int publishes = 0;
+    double passes_per_second() const { return total_time > 0 ? passes / total_time : 0; }
+};
+
+// Writes 8 bit RGB pixels as a binary PPM. The file is written next to `path` and
+// renamed over it, so a reader never sees a half written image.
+bool publish_framebuffer(const std::string& path, const std::vector<unsigned char>& rgb,
+                         int width, int height);
+
+// Runs the progressive render over `tiles` and leaves the averaged image in `data`.
+// `settings.num_threads` must be at least 1.
+preview_stats run_preview(camera& cam, const hittable& world,
+                          const std::vector<std::pair<int, int>>& tiles,
+                          const preview_settings& settings, std::vector<color>& data);
+
+#endif
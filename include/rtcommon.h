@@ -31,6 +31,10 @@ inline double random_double() {
 inline double random_double(double min, double max) {
     return min + (max-min)*random_double();
 }
+
+inline double seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
 // Common Headers
 #include "color.h"
 #include "interval.h"
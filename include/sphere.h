@@ -4,13 +4,38 @@
 #include "hittable.h"
 #include "rtcommon.h"
 
+// Finds the nearest root of the ray/sphere intersection that lies inside ray_t.
+// Shared by sphere::hit and the closed-set primitives in static_scene.h.
+inline bool hit_sphere(const point3& center, double radius, const ray& r, interval ray_t, double& root) {
+    vec3 oc  = center - r.origin();
+    auto a = r.direction().length_squared();
+    auto h = dot(r.direction(), oc);
+    auto c = oc.length_squared() - radius*radius;
+
+    auto discriminant = h*h - a*c;
+    if (discriminant < 0)
+        return false;
+
+    auto sqrtd = std::sqrt(discriminant);
+
+    // Find the nearest root that lies in the acceptable range
+    root = (h - sqrtd) / a;
+    if (!ray_t.surrounds(root)) {
+        root = (h + sqrtd) / a;
+        if (!ray_t.surrounds(root))
+            return false;
+    }
+    return true;
+}
+
 class sphere: public hittable {
     private:
         point3 center;
         double radius;
         shared_ptr<material> mat;
+        friend class static_scene;
     public:
         sphere(const point3& c, double r, shared_ptr<material> m) : center(c), radius(std::fmax(0, r)), mat(m) {}
         bool hit(const ray& r, interval ray_t, hit_record& rec) const override;
 };
-#endif
\ No newline at end of file
+#endif
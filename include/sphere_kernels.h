@@ -0,0 +1,35 @@
+#ifndef SPHERE_KERNELS_H
+#define SPHERE_KERNELS_H
+
+#include "rtcommon.h"
+#include <string>
+
+// Spheres in structure of arrays layout for the vectorised intersection kernels. The arrays
+// are padded to a multiple of `lane_padding` with NaN spheres, which never report a hit.
+class sphere_soa {
+    public:
+        static constexpr size_t lane_padding = 8;
+        std::vector<double> cx, cy, cz, radius;
+        size_t count = 0; // Number of real spheres, without the padding
+
+        void clear();
+        void add(const point3& center, double r);
+};
+
+// Instruction sets the intersection kernel is compiled for. The best one the CPU supports
+// is picked at startup. `none` is never picked, it has static_scene skip the kernel and
+// visit its spheres through the primitive variant instead.
+enum class simd_level { none, scalar, sse2, avx2, avx512 };
+
+const char* simd_level_name(simd_level level);
+bool parse_simd_level(const std::string& name, simd_level& level);
+simd_level best_simd_level();
+simd_level active_simd_level();
+// Forces a kernel, e.g. to compare them. Returns false if the CPU does not support it.
+bool set_simd_level(simd_level level);
+
+// Returns the index of the nearest sphere hit by `r` with t in the open interval ray_t
+// and stores that t in `t_hit`, or returns -1 if no sphere is hit.
+int hit_spheres(const sphere_soa& spheres, const ray& r, interval ray_t, double& t_hit);
+
+#endif
@@ -0,0 +1,114 @@
+#ifndef STATIC_SCENE_H
+#define STATIC_SCENE_H
+
+#include "rtcommon.h"
+#include "hittable_list.h"
+#include "material.h"
+#include "sphere.h"
+#include "sphere_kernels.h"
+#include <variant>
+
+// Closed-set scene representation. Materials and primitives are stored by value in
+// std::variant vectors, so every hit and scatter is a switch on the variant index followed
+// by a direct call the compiler can inline, instead of a virtual call through shared_ptr.
+
+using material_variant = std::variant<lambertian, metal, dielectric>;
+
+// Like hit_record, but refers to the material by index, which avoids copying a shared_ptr
+// (and touching its reference count) on every closer hit.
+class static_hit_record {
+    public:
+        point3 p;
+        vec3 normal;
+        double t;
+        int mat;
+        bool front_face;
+
+        void set_face_normal(const ray& r, const vec3& outward_normal) {
+            front_face = dot(r.direction(), outward_normal) < 0;
+            normal = front_face ? outward_normal : -outward_normal;
+        }
+};
+
+class sphere_primitive {
+    public:
+        point3 center;
+        double radius;
+        int mat;
+
+        sphere_primitive(const point3& c, double r, int m) : center(c), radius(r), mat(m) {}
+
+        bool hit(const ray& r, interval ray_t, static_hit_record& rec) const {
+            double root;
+            if (!hit_sphere(center, radius, r, ray_t, root))
+                return false;
+            set_record(r, root, rec);
+            return true;
+        }
+
+        void set_record(const ray& r, double t, static_hit_record& rec) const {
+            rec.t = t;
+            rec.p = r.at(rec.t);
+            rec.set_face_normal(r, (rec.p - center) / radius);
+            rec.mat = mat;
+        }
+};
+
+using primitive_variant = std::variant<sphere_primitive>;
+
+class static_scene {
+    public:
+        std::vector<material_variant> materials;
+        std::vector<primitive_variant> primitives;
+        // The sphere primitives are mirrored here so hit() can test them all with the SIMD
+        // kernel picked for this CPU. Sphere k is primitives[sphere_primitive_index[k]]. All other
+        // primitives, and the spheres too with --isa=none, are listed in variant_primitives and
+        // visited through the variant.
+        sphere_soa spheres;
+        std::vector<int> sphere_primitive_index;
+        std::vector<int> variant_primitives;
+        bool use_sphere_kernel = true;
+
+        // Copies `world` into the closed set. Returns false if it contains an object or
+        // material type the variants do not know about. Reads active_simd_level() to decide
+        // whether spheres go through the sphere kernel.
+        bool build(const hittable_list& world);
+        // Appends a primitive, keeping the sphere and other primitive indices in sync.
+        void add_primitive(const primitive_variant& primitive);
+
+        bool hit(const ray& r, interval ray_t, static_hit_record& rec) const {
+            bool hit_anything = false;
+            double t;
+            int nearest = spheres.count > 0 ? hit_spheres(spheres, r, ray_t, t) : -1;
+            if (nearest >= 0) {
+                std::get<sphere_primitive>(primitives[sphere_primitive_index[nearest]]).set_record(r, t, rec);
+                hit_anything = true;
+                ray_t.max = t;
+            }
+            for (int index : variant_primitives) {
+                bool hit = std::visit([&](const auto& p) {
+                    return p.hit(r, ray_t, rec);
+                }, primitives[index]);
+                if (hit) {
+                    hit_anything = true;
+                    ray_t.max = rec.t;
+                }
+            }
+            return hit_anything;
+        }
+
+        bool scatter(const ray& r_in, const static_hit_record& rec, color& attenuation, ray& scattered) const {
+            return std::visit([&](const auto& m) {
+                return m.scatter(r_in, rec.p, rec.normal, rec.front_face, attenuation, scattered);
+            }, materials[rec.mat]);
+        }
+
+        // Variant index of a material, used to group hits of the same material kind.
+        int material_kind(int mat) const { return int(materials[mat].index()); }
+        static constexpr int material_kinds = std::variant_size_v<material_variant>;
+
+    private:
+        bool add(const hittable& object, std::vector<std::pair<const material*, int>>& material_ids);
+};
+
+#endif
@@ -0,0 +1,27 @@
+#ifndef TILES_H
+#define TILES_H
+
+#include <string>
+#include <utility>
+#include <vector>
+
+// Order in which the image tiles are handed out to the worker threads.
+enum class tile_order {
+    raster, // Row by row, left to right
+    morton, // Z-order curve, keeps neighbouring tiles close together in time
+    spiral  // Square spiral starting from the centre tile
+};
+
+// Parses "raster", "morton" or "spiral". Returns false for anything else.
+bool parse_tile_order(const std::string& name, tile_order& order);
+const char* tile_order_name(tile_order order);
+
+// Number of tiles needed to cover `image_size` pixels, counting a partial edge tile.
+inline int tile_count(int image_size, int block_size) {
+    return (image_size + block_size - 1) / block_size;
+}
+
+// Returns all (x, y) tile indices of a tiles_x by tiles_y grid in the given order.
+std::vector<std::pair<int, int>> generate_tiles(int tiles_x, int tiles_y, tile_order order);
+
+#endif
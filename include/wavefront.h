@@ -0,0 +1,74 @@
+#ifndef WAVEFRONT_H
+#define WAVEFRONT_H
+
+#include "camera.h"
+#include "static_scene.h"
+
+// Paths in flight, stored as structure of arrays so each stage streams through only the
+// fields it needs.
+class ray_queue {
+    public:
+        std::vector<double> ox, oy, oz;   // Ray origin
+        std::vector<double> dx, dy, dz;   // Ray direction
+        std::vector<double> tr, tg, tb;   // Path throughput
+        std::vector<int> pixel;           // Index of the pixel in the tile
+
+        size_t size() const { return pixel.size(); }
+        void clear();
+        void reserve(size_t n);
+        void push(const ray& r, const color& throughput, int pix);
+
+        ray get_ray(size_t k) const {
+            return ray(point3(ox[k], oy[k], oz[k]), vec3(dx[k], dy[k], dz[k]));
+        }
+        color throughput(size_t k) const { return color(tr[k], tg[k], tb[k]); }
+        void set(size_t k, const ray& r, const color& throughput);
+        // Moves entry `from` to slot `to`, used when compacting.
+        void move(size_t from, size_t to);
+        void resize(size_t n);
+};
+
+// Time spent in each stage (thread-seconds) and number of active rays entering each bounce.
+struct wavefront_stats {
+    double generate_seconds = 0;
+    double intersect_seconds = 0;
+    double shade_seconds = 0;
+    double compact_seconds = 0;
+    std::vector<long long> active_rays;
+
+    void merge(const wavefront_stats& other);
+    void print(std::ostream& out) const;
+};
+
+// Renders tiles of a static_scene in batches of paths. Each bounce runs the stages
+// intersect -> shade (grouped by material kind) -> compact over the whole batch, instead of
+// following one path to the end as camera::ray_color does. One instance per thread, the
+// buffers are reused from tile to tile.
+class wavefront_integrator {
+    public:
+        wavefront_integrator(const camera& cam, const static_scene& world, int batch_size = 1 << 16)
+            : cam(cam), world(world), batch_size(batch_size) {}
+
+        void render(std::vector<color>& data, const int sub_x, const int sub_y, wavefront_stats& stats);
+
+    private:
+        const camera& cam;
+        const static_scene& world;
+        int batch_size;
+
+        ray_queue queue;
+        // Hit data of queue entry k, valid for the current bounce.
+        std::vector<double> hit_px, hit_py, hit_pz;
+        std::vector<double> hit_nx, hit_ny, hit_nz;
+        std::vector<char> hit_front;
+        std::vector<int> hit_mat;       // -1 for a miss
+        std::vector<char> alive;
+        std::vector<int> order;         // Queue entries sorted by material kind
+        std::vector<color> sum;         // Per pixel of the tile
+
+        void intersect(wavefront_stats& stats);
+        void shade(wavefront_stats& stats);
+        void compact(wavefront_stats& stats);
+};
+
+#endif
@@ -0,0 +1,62 @@
+#!/usr/bin/env bash
+# Builds the optimisation variants from the Makefile and compares their primary rays per
+# second on the default scene, for each integrator and for each sphere kernel the CPU supports.
+#
+# Usage: scripts/compare_builds.sh [SAMPLES] [NUM_THREADS] [IMAGE_WIDTH] [RUNS]
+# Set SKIP_BUILD=1 to reuse binaries that are already built.
+set -euo pipefail
+
+SAMPLES=${1:-16}
+THREADS=${2:--1}
+WIDTH=${3:-320}
+RUNS=${4:-3}
+ARCHS=${ARCHS:-"x86-64 x86-64-v3 native"}
+
+cd "$(dirname "$0")/.."
+ROOT=$(pwd)
+
+if [ "${SKIP_BUILD:-0}" != 1 ]; then
+    make --no-print-directory > /dev/null
+    for arch in $ARCHS; do
+        make --no-print-directory release MARCH="$arch" > /dev/null
+    done
+    make --no-print-directory pgo > /dev/null
+fi
+
+# Renders go to a scratch directory so imagefile.ppm and performance_logs.txt are untouched.
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+# Best of RUNS, in million primary rays per second.
+measure() {
+    local best=0 rays
+    for _ in $(seq "$RUNS"); do
+        rays=$(cd "$WORK" && "$@" | awk -F': ' '/Primary rays per second/ {print $2}')
+        best=$(awk -v a="$best" -v b="$rays" 'BEGIN {print (b > a) ? b : a}')
+    done
+    awk -v r="$best" 'BEGIN {printf "%8.3f", r / 1e6}'
+}
+
+echo "Default scene, $WIDTH px wide, $SAMPLES spp, threads $THREADS, best of $RUNS runs"
+echo "Million primary rays per second"
+printf "%-24s %9s %9s %9s\n" build virtual variant wavefront
+binaries="ray_tracer"
+for arch in $ARCHS; do binaries="$binaries ray_tracer_$arch"; done
+binaries="$binaries ray_tracer_pgo"
+for bin in $binaries; do
+    printf "%-24s" "$bin"
+    for mode in "" --variant --wavefront; do
+        printf " %s" "$(measure "$ROOT/$bin" $mode "$SAMPLES" "$THREADS" "$WIDTH")"
+    done
+    echo
+done
+
+echo
+echo "Sphere kernels (ray_tracer, --variant; none is std::visit dispatch without a kernel)"
+for isa in none scalar sse2 avx2 avx512; do
+    if (cd "$WORK" && "$ROOT/ray_tracer" --isa=$isa 1 1 8 > /dev/null 2>&1); then
+        printf "%-24s %s\n" "$isa" "$(measure "$ROOT/ray_tracer" --variant --isa=$isa "$SAMPLES" "$THREADS" "$WIDTH")"
+    else
+        printf "%-24s %s\n" "$isa" "not supported"
+    fi
+done
@@ -1,18 +1,42 @@
 #include "camera.h"
-void camera::render(const hittable& world, std::vector<color>& data, const int sub_x, const int sub_y) {
-    for (int j = block_size_y*sub_y; j < block_size_y*(sub_y+1); j++) {
+
+#include <algorithm>
+#include "static_scene.h"
+
+template <typename World>
+void camera::render(const World& world, std::vector<color>& data, const int sub_x, const int sub_y) {
+    const tile_rect tile = tile_bounds(sub_x, sub_y);
+    for (int j = tile.start_y; j < tile.end_y; j++) {
         // std::clog << "\rScanlines remaining: " << (image_height - j) << ' ' << std::flush;
-        for (int i = block_size_x*sub_x; i < block_size_x*(sub_x+1); i++) {
+        for (int i = tile.start_x; i < tile.end_x; i++) {
             color pixel_color(0, 0, 0);
             for (int sample = 0; sample < samples_per_pixel; sample++) {
                 ray r = get_ray(i, j);
                 pixel_color += ray_color(r, max_depth, world);
             }
-            data[j*image_width + i] = pixel_color*pixel_samples_scale;
+            data[size_t(j)*image_width + i] = pixel_color*pixel_samples_scale;
         }
     }
     // std::clog << "\rDone.                 \n";
 }
+template void camera::render<hittable>(const hittable&, std::vector<color>&, const int, const int);
+template void camera::render<static_scene>(const static_scene&, std::vector<color>&, const int, const int);
+
+void camera::render_pass(const hittable& world, std::vector<color>& accum, const int sub_x, const int sub_y) {
+    const tile_rect tile = tile_bounds(sub_x, sub_y);
+    for (int j = tile.start_y; j < tile.end_y; j++) {
+        for (int i = tile.start_x; i < tile.end_x; i++) {
+            ray r = get_ray(i, j);
+            accum[size_t(j)*image_width + i] += ray_color(r, max_depth, world);
+        }
+    }
+}
+
+tile_rect camera::tile_bounds(const int sub_x, const int sub_y) const {
+    return tile_rect{block_size_x*sub_x, block_size_y*sub_y,
+                     std::min(block_size_x*(sub_x+1), image_width),
+                     std::min(block_size_y*(sub_y+1), image_height)};
+}
 
 void camera::initialize() {
     image_height = int(image_width / aspect_ratio);
@@ -62,6 +86,24 @@ color camera::ray_color(const ray& r, int depth, const hittable& world) const {
             return attenuation*ray_color(scattered, depth-1, world);
         return color(0, 0, 0);
     }
+    return background(r);
+}
+
+color camera::ray_color(const ray& r, int depth, const static_scene& world) const {
+    if (depth <= 0)
+        return color(0, 0, 0);
+    static_hit_record rec;
+    if (world.hit(r, interval(0.0001, infinity), rec)) {
+        ray scattered;
+        color attenuation;
+        if (world.scatter(r, rec, attenuation, scattered))
+            return attenuation*ray_color(scattered, depth-1, world);
+        return color(0, 0, 0);
+    }
+    return background(r);
+}
+
+color camera::background(const ray& r) const {
     vec3 unit_direction = unit_vector(r.direction());
     auto a = 0.5*(unit_direction.y() + 1.0);
     return (1.0 - a)*color(1.0, 1.0, 1.0) + a*color(0.5, 0.7, 1.0);
@@ -5,21 +5,16 @@ inline double linear_to_gamma(double linear_component) {
     return 0;
 }
 
-void write_color(std::ofstream& out, const color& pixel_colour) {
-    auto r = pixel_colour.x();
-    auto g = pixel_colour.y();
-    auto b = pixel_colour.z();
-    // Applying linear to gamma transform for gamma 2
-    r = linear_to_gamma(r);
-    g = linear_to_gamma(g);
-    b = linear_to_gamma(b);
-
-    // Translating the [0, 1] component values to the byte range [0, 255]
+void color_to_bytes(const color& pixel_colour, unsigned char bytes[3]) {
+    // Applying linear to gamma transform for gamma 2, then translating
+    // the [0, 1] component values to the byte range [0, 255]
     static const interval intensity(0.000, 0.999);
-    short rbyte = short(255.999 * intensity.clamp(r));
-    short gbyte = short(255.999 * intensity.clamp(g));
-    short bbyte = short(255.999 * intensity.clamp(b));
-
+    for (int k = 0; k < 3; k++)
+        bytes[k] = (unsigned char)(255.999 * intensity.clamp(linear_to_gamma(pixel_colour[k])));
+}
 
-    out << rbyte << ' ' << gbyte << ' ' << bbyte << '\n';
+void write_color(std::ofstream& out, const color& pixel_colour) {
+    unsigned char bytes[3];
+    color_to_bytes(pixel_colour, bytes);
+    out << short(bytes[0]) << ' ' << short(bytes[1]) << ' ' << short(bytes[2]) << '\n';
 }
\ No newline at end of file
@@ -4,19 +4,84 @@
 #include "hittable.h"
 #include "hittable_list.h"
 #include "material.h"
+#include "preview.h"
 #include "sphere.h"
+#include "sphere_kernels.h"
+#include "static_scene.h"
 #include "threadsafequeue.h"
+#include "tiles.h"
+#include "wavefront.h"
 
-void worker_function(ThreadSafeQueue& task_queue,  camera& cam, hittable& world, std::vector<color>& data);
+// How hits and scatters are dispatched while rendering.
+enum class integrator_kind {
+    virtual_calls, // hittable / material class hierarchy
+    variant,       // static_scene, std::variant dispatch
+    wavefront      // static_scene, batches of paths advanced one bounce at a time
+};
+
+void worker_function(ThreadSafeQueue& task_queue,  camera& cam, hittable& world, const static_scene& fast_world,
+                     integrator_kind integrator, std::vector<color>& data, wavefront_stats& stats);
 
 int main(int argc, char* argv[]) {
-    if (argc != 3) {
-        std::cout  << "Usage: ./ray_tracer (SAMPLES) (NUM_THREADS)" << std::endl;
+    const char* usage = "Usage: ./ray_tracer [--preview] [--variant|--wavefront] [--isa=LEVEL] (SAMPLES) (NUM_THREADS) [IMAGE_WIDTH] [raster|morton|spiral]";
+    // With --preview, SAMPLES is rendered as that many 1 spp passes, publishing preview.ppm as it goes.
+    // --variant and --wavefront select the closed-set scene instead of the virtual class hierarchy.
+    // --isa=scalar|sse2|avx2|avx512 overrides the sphere intersection kernel picked for this CPU,
+    // --isa=none tests the spheres through the variant dispatch alone.
+    bool preview = false;
+    integrator_kind integrator = integrator_kind::virtual_calls;
+    const char* integrator_name = "virtual";
+    while (argc > 1 && std::string(argv[1]).rfind("--", 0) == 0) {
+        std::string flag = argv[1];
+        if (flag == "--preview") {
+            preview = true;
+        } else if (flag == "--variant") {
+            integrator = integrator_kind::variant;
+            integrator_name = "variant";
+        } else if (flag == "--wavefront") {
+            integrator = integrator_kind::wavefront;
+            integrator_name = "wavefront";
+        } else if (flag.rfind("--isa=", 0) == 0) {
+            simd_level level;
+            if (!parse_simd_level(flag.substr(6), level) || !set_simd_level(level)) {
+                std::cout << "Instruction set '" << flag.substr(6) << "' is unknown or not supported by this CPU" << std::endl;
+                return 1;
+            }
+        } else {
+            std::cout << "Unknown option '" << flag << "'" << std::endl;
+            return 1;
+        }
+        argv++;
+        argc--;
+    }
+    if (argc < 3 || argc > 5) {
+        std::cout  << usage << std::endl;
+        return 1;
+    }
+    if (preview && integrator != integrator_kind::virtual_calls) {
+        std::cout << "--preview only supports the virtual integrator" << std::endl;
         return 1;
     }
     int samples = std::stoi(argv[1]);
     int num_threads = std::stoi(argv[2]);
     if (num_threads==-1) num_threads = std::thread::hardware_concurrency();
+    // hardware_concurrency() may also return 0 when it cannot tell.
+    if (num_threads < 1) {
+        std::cout  << usage << std::endl;
+        std::cout << "NUM_THREADS must be at least 1, or -1 for one per hardware thread" << std::endl;
+        return 1;
+    }
+    int image_width = (argc > 3) ? std::stoi(argv[3]) : 32*30;
+    if (image_width < 1) {
+        std::cout  << usage << std::endl;
+        std::cout << "IMAGE_WIDTH must be at least 1" << std::endl;
+        return 1;
+    }
+    tile_order order = tile_order::raster;
+    if (argc > 4 && !parse_tile_order(argv[4], order)) {
+        std::cout << "Unknown tile order '" << argv[4] << "', expected raster, morton or spiral" << std::endl;
+        return 1;
+    }
 
     // We will first make the queue
     hittable_list world;
@@ -61,13 +126,19 @@ int main(int argc, char* argv[]) {
     auto material3 = make_shared<metal>(color(0.7, 0.6, 0.5), 0.0);
     world.add(make_shared<sphere>(point3(4, 1, 0), 1.0, material3));
 
+    static_scene fast_world;
+    if (integrator != integrator_kind::virtual_calls && !fast_world.build(world)) {
+        std::cout << "Scene contains types the static scene does not support" << std::endl;
+        return 1;
+    }
+
     // Now we intitialse the camera
 
    
     camera cam;
 
     cam.aspect_ratio      = 30.0/20.0;
-    cam.image_width       = 32*30;
+    cam.image_width       = image_width;
     cam.samples_per_pixel = samples;
     cam.max_depth         = 50;
 
@@ -84,29 +155,51 @@ int main(int argc, char* argv[]) {
 
     cam.initialize();
 
-    std::vector<color> data(cam.image_width * cam.image_height);
+    std::vector<color> data(size_t(cam.image_width) * cam.image_height);
+
+    // Block coordinates as (x,y), rounded up so that partial edge tiles are rendered too.
+    int tiles_x = tile_count(cam.image_width, cam.block_size_x);
+    int tiles_y = tile_count(cam.image_height, cam.block_size_y);
+    std::vector<std::pair<int, int>> tiles = generate_tiles(tiles_x, tiles_y, order);
 
-    // Now we will construct the task queue.
-    // It stores block starting coordinates as (x,y)
-    ThreadSafeQueue task_queue;
-    for (int j=0; j < int(cam.image_height/cam.block_size_y); j++) {
-        for (int i=0; i< int(cam.image_width)/cam.block_size_x;i++) {
-            task_queue.push(std::make_pair(i, j));
-        }
-    }
-    
     auto start = std::chrono::steady_clock::now();
-    // Creating the thread workers
-    std::vector<std::thread> workers;
-    for (int i = 0; i < num_threads; ++i) {
-        workers.emplace_back(worker_function, std::ref(task_queue), std::ref(cam), std::ref(world), std::ref(data));
-    }
+    preview_stats stats;
+    wavefront_stats wf_stats;
+    if (preview) {
+        preview_settings settings;
+        settings.passes = samples;
+        settings.num_threads = num_threads;
+        stats = run_preview(cam, world, tiles, settings, data);
+        std::cout << "Time to first image: " << stats.time_to_first_image << " s, "
+                  << stats.passes_per_second() << " passes/s, "
+                  << stats.publishes << " frames published in " << stats.publish_time << " s" << std::endl;
+    } else {
+        // Now we will construct the task queue.
+        ThreadSafeQueue task_queue;
+        for (const auto& tile : tiles) {
+            task_queue.push(tile);
+        }
+        // Creating the thread workers, each with its own wavefront counters.
+        std::vector<std::thread> workers;
+        std::vector<wavefront_stats> worker_stats(num_threads);
+        for (int i = 0; i < num_threads; ++i) {
+            workers.emplace_back(worker_function, std::ref(task_queue), std::ref(cam), std::ref(world),
+                                 std::cref(fast_world), integrator, std::ref(data), std::ref(worker_stats[i]));
+        }
 
-    task_queue.shutdown();
+        task_queue.shutdown();
 
-    for (auto& thread : workers) {
-        thread.join();
+        for (auto& thread : workers) {
+            thread.join();
+        }
+        for (const auto& s : worker_stats)
+            wf_stats.merge(s);
+        if (integrator == integrator_kind::wavefront)
+            wf_stats.print(std::cout);
     }
+    // Taken before the image is written, so the rays per second below measure rendering only.
+    auto render_end = std::chrono::steady_clock::now();
+
     std::ofstream imageFile;
     imageFile.open("imagefile.ppm", std::ios::out);
     imageFile << "P3\n" << cam.image_width << ' ' << cam.image_height << "\n255\n";
@@ -116,6 +209,15 @@ int main(int argc, char* argv[]) {
     }
     auto end = std::chrono::steady_clock::now();
     auto duration_seconds = std::chrono::duration_cast<std::chrono::seconds>(end - start);
+    // Camera rays only, so the figure is comparable between integrators and builds.
+    double render_seconds = std::chrono::duration<double>(render_end - start).count();
+    double primary_rays_per_second = double(cam.image_width) * cam.image_height * cam.samples_per_pixel / render_seconds;
+    // Only the static scene integrators go through the dispatched sphere kernel.
+    bool uses_sphere_kernel = integrator != integrator_kind::virtual_calls;
+    std::cout << "Render time(SECONDS): " << render_seconds
+              << "\nPrimary rays per second: " << primary_rays_per_second << std::endl;
+    if (uses_sphere_kernel)
+        std::cout << "Sphere kernel: " << simd_level_name(active_simd_level()) << std::endl;
     std::ofstream logFile;
     logFile.open("performance_logs.txt", std::ios::app);
      if (!logFile.is_open()) {
@@ -134,15 +236,43 @@ int main(int argc, char* argv[]) {
                 << "\nFocus dist: " << cam.focus_dist \ */
                 << "\nCPU Threads: " << num_threads \
                 << "\nBlock size x " << cam.block_size_x \
-                << "\nTIME TAKEN(SECONDS): " << duration_seconds.count();
+                << "\nTile order: " << tile_order_name(order) \
+                << "\nIntegrator: " << integrator_name \
+                << "\nPrimary rays per second: " << primary_rays_per_second;
+    if (uses_sphere_kernel) {
+        logFile << "\nSphere kernel: " << simd_level_name(active_simd_level());
+    }
+    if (preview) {
+        logFile << "\nPreview passes: " << stats.passes \
+                << "\nTime to first image(SECONDS): " << stats.time_to_first_image \
+                << "\nPasses per second: " << stats.passes_per_second() \
+                << "\nPublish time(SECONDS): " << stats.publish_time;
+    }
+    if (integrator == integrator_kind::wavefront) {
+        logFile << "\nStage seconds generate/intersect/shade/compact: " << wf_stats.generate_seconds \
+                << '/' << wf_stats.intersect_seconds << '/' << wf_stats.shade_seconds << '/' << wf_stats.compact_seconds;
+    }
+    logFile << "\nTIME TAKEN(SECONDS): " << duration_seconds.count();
     logFile << "\n-----------";
     logFile.close();
 }
 
-void worker_function(ThreadSafeQueue& task_queue, camera& cam, hittable& world, std::vector<color> & data) {
+void worker_function(ThreadSafeQueue& task_queue, camera& cam, hittable& world, const static_scene& fast_world,
+                     integrator_kind integrator, std::vector<color> & data, wavefront_stats& stats) {
+    wavefront_integrator wavefront(cam, fast_world);
     while (true) {
         std::optional<std::pair<int, int>> task = task_queue.pop();
         if (task == std::nullopt) break;
-        cam.render(world, data, task.value().first, task.value().second);
+        switch (integrator) {
+            case integrator_kind::virtual_calls:
+                cam.render(world, data, task.value().first, task.value().second);
+                break;
+            case integrator_kind::variant:
+                cam.render(fast_world, data, task.value().first, task.value().second);
+                break;
+            case integrator_kind::wavefront:
+                wavefront.render(data, task.value().first, task.value().second, stats);
+                break;
+        }
     }
 }
\ No newline at end of file
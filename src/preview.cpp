@@ -0,0 +1,155 @@
+#include "preview.h"
+
+#include <cassert>
+#include <cstdio>
+#include "threadsafequeue.h"
+
+namespace {
+// Shared between the workers, the thread feeding them passes, and the publisher.
+// Each tile has its own lock and pass count, so the publisher can take a consistent
+// average of one tile while the workers keep accumulating into the others.
+struct preview_state {
+    camera& cam;
+    const hittable& world;
+    const std::vector<std::pair<int, int>>& tiles;
+    std::vector<color> accum;
+    std::vector<std::mutex> tile_locks;
+    std::vector<int> tile_passes;
+
+    std::mutex mtx;
+    std::condition_variable cv;
+    long long tasks_done = 0;
+    size_t tiles_sampled = 0; // Tiles with at least one pass
+    bool finished = false;
+
+    preview_state(camera& cam, const hittable& world, const std::vector<std::pair<int, int>>& tiles, size_t pixels)
+        : cam(cam), world(world), tiles(tiles), accum(pixels), tile_locks(tiles.size()), tile_passes(tiles.size(), 0) {}
+};
+
+// Tasks are (tile index, pass), the pass only matters for the order they are queued in.
+void preview_worker(ThreadSafeQueue& task_queue, preview_state& state) {
+    while (true) {
+        std::optional<std::pair<int, int>> task = task_queue.pop();
+        if (task == std::nullopt) break;
+        int t = task.value().first;
+        bool first_sample;
+        {
+            std::lock_guard<std::mutex> lg(state.tile_locks[t]);
+            state.cam.render_pass(state.world, state.accum, state.tiles[t].first, state.tiles[t].second);
+            first_sample = state.tile_passes[t]++ == 0;
+        }
+        {
+            std::lock_guard<std::mutex> lg(state.mtx);
+            state.tasks_done++;
+            if (first_sample)
+                state.tiles_sampled++;
+        }
+        state.cv.notify_all();
+    }
+}
+
+// Converts the current average to bytes, holding each tile's lock only while copying it.
+void snapshot(preview_state& state, std::vector<unsigned char>& rgb) {
+    const camera& cam = state.cam;
+    for (size_t t = 0; t < state.tiles.size(); t++) {
+        const tile_rect tile = cam.tile_bounds(state.tiles[t].first, state.tiles[t].second);
+        std::lock_guard<std::mutex> lg(state.tile_locks[t]);
+        double scale = state.tile_passes[t] > 0 ? 1.0 / state.tile_passes[t] : 0;
+        for (int j = tile.start_y; j < tile.end_y; j++) {
+            for (int i = tile.start_x; i < tile.end_x; i++) {
+                size_t k = size_t(j)*cam.image_width + i;
+                color_to_bytes(state.accum[k] * scale, &rgb[3*k]);
+            }
+        }
+    }
+}
+}
+
+bool publish_framebuffer(const std::string& path, const std::vector<unsigned char>& rgb,
+                         int width, int height) {
+    std::string tmp_path = path + ".tmp";
+    std::ofstream out(tmp_path, std::ios::out | std::ios::binary);
+    if (!out.is_open())
+        return false;
+    out << "P6\n" << width << ' ' << height << "\n255\n";
+    out.write(reinterpret_cast<const char*>(rgb.data()), rgb.size());
+    out.close();
+    if (!out)
+        return false;
+    return std::rename(tmp_path.c_str(), path.c_str()) == 0;
+}
+
+preview_stats run_preview(camera& cam, const hittable& world,
+                          const std::vector<std::pair<int, int>>& tiles,
+                          const preview_settings& settings, std::vector<color>& data) {
+    // The feeder below waits for the workers to finish earlier passes, so without any it never returns.
+    assert(settings.num_threads >= 1);
+    preview_stats stats;
+    stats.passes = settings.passes;
+    preview_state state(cam, world, tiles, data.size());
+    auto start = std::chrono::steady_clock::now();
+
+    // One pool of workers for all passes.
+    ThreadSafeQueue task_queue;
+    std::vector<std::thread> workers;
+    for (int i = 0; i < settings.num_threads; ++i)
+        workers.emplace_back(preview_worker, std::ref(task_queue), std::ref(state));
+
+    // The publisher waits for every tile to have a sample, then writes a frame every
+    // publish_interval_ms and a last one once the workers are done.
+    std::thread publisher([&] {
+        std::vector<unsigned char> rgb(data.size() * 3);
+        auto publish = [&] {
+            auto publish_start = std::chrono::steady_clock::now();
+            snapshot(state, rgb);
+            if (!publish_framebuffer(settings.output_path, rgb, cam.image_width, cam.image_height))
+                std::cerr << "Error: Unable to write " << settings.output_path << std::endl;
+            stats.publish_time += seconds_since(publish_start);
+            if (stats.publishes++ == 0)
+                stats.time_to_first_image = seconds_since(start);
+        };
+
+        std::unique_lock<std::mutex> ul(state.mtx);
+        state.cv.wait(ul, [&] { return state.tiles_sampled == tiles.size() || state.finished; });
+        while (!state.finished) {
+            ul.unlock();
+            publish();
+            std::clog << "\rPublished " << stats.publishes << " frames after "
+                      << seconds_since(start) << " s   " << std::flush;
+            ul.lock();
+            state.cv.wait_for(ul, std::chrono::milliseconds(settings.publish_interval_ms),
+                              [&] { return state.finished; });
+        }
+        ul.unlock();
+        publish();
+    });
+
+    // Queue pass p once pass p - 2 is about done, so the workers always have work without
+    // holding every pass of a large image in the queue at once.
+    const long long tiles_per_pass = (long long)tiles.size();
+    for (int pass = 0; pass < settings.passes; pass++) {
+        {
+            std::unique_lock<std::mutex> ul(state.mtx);
+            state.cv.wait(ul, [&] { return state.tasks_done >= (pass - 1) * tiles_per_pass; });
+        }
+        for (size_t t = 0; t < tiles.size(); t++)
+            task_queue.push(std::make_pair(int(t), pass));
+    }
+    task_queue.shutdown();
+    for (auto& thread : workers)
+        thread.join();
+    stats.total_time = seconds_since(start);
+
+    {
+        std::lock_guard<std::mutex> lg(state.mtx);
+        state.finished = true;
+    }
+    state.cv.notify_all();
+    publisher.join();
+    std::clog << '\n';
+
+    double scale = settings.passes > 0 ? 1.0 / settings.passes : 0;
+    for (size_t k = 0; k < data.size(); k++)
+        data[k] = state.accum[k] * scale;
+    return stats;
+}
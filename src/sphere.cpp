@@ -1,24 +1,9 @@
 #include "sphere.h"
 bool sphere::hit(const ray& r, interval ray_t, hit_record& rec) const {
-            vec3 oc  = center - r.origin();
-            auto a = r.direction().length_squared();
-            auto h = dot(r.direction(), oc);
-            auto c = oc.length_squared() - radius*radius;
-
-            auto discriminant = h*h - a*c;
-            if (discriminant < 0)
+            double root;
+            if (!hit_sphere(center, radius, r, ray_t, root))
                 return false;
 
-            auto sqrtd = std::sqrt(discriminant);
-
-            // Find the nearest root that lies in the acceptable range
-            auto root = (h - sqrtd) / a;
-            if (!ray_t.surrounds(root)) {
-                root = (h + sqrtd) / a;
-                if (!ray_t.surrounds(root))
-                    return false;
-            }
-
             // Storing record of hit. 
             rec.t = root;
             rec.p = r.at(rec.t);
@@ -27,4 +12,4 @@ bool sphere::hit(const ray& r, interval ray_t, hit_record& rec) const {
             rec.mat = mat;
 
             return true;
-        }
\ No newline at end of file
+        }
@@ -0,0 +1,262 @@
+#include "sphere_kernels.h"
+
+#include "sphere.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define RT_X86 1
+#include <immintrin.h>
+#endif
+
+void sphere_soa::clear() {
+    cx.clear(); cy.clear(); cz.clear(); radius.clear();
+    count = 0;
+}
+
+void sphere_soa::add(const point3& center, double r) {
+    // Drop the padding of the previous add, append, then pad again.
+    cx.resize(count); cy.resize(count); cz.resize(count); radius.resize(count);
+    cx.push_back(center.x()); cy.push_back(center.y()); cz.push_back(center.z());
+    radius.push_back(r);
+    count++;
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    while (cx.size() % lane_padding != 0) {
+        cx.push_back(nan); cy.push_back(nan); cz.push_back(nan);
+        radius.push_back(0);
+    }
+}
+
+namespace {
+using hit_spheres_fn = int (*)(const sphere_soa&, const ray&, interval, double&);
+
+int hit_spheres_scalar(const sphere_soa& s, const ray& r, interval ray_t, double& t_hit) {
+    int nearest = -1;
+    for (size_t j = 0; j < s.count; j++) {
+        double root;
+        if (hit_sphere(point3(s.cx[j], s.cy[j], s.cz[j]), s.radius[j], r, ray_t, root)) {
+            nearest = int(j);
+            ray_t.max = root;
+        }
+    }
+    t_hit = ray_t.max;
+    return nearest;
+}
+
+#ifdef RT_X86
+// Picks the nearest hit out of the per-lane results. On equal t the lower sphere index wins,
+// which matches the order the scalar loop visits them in.
+int reduce_lanes(const double* t, const double* index, int lanes, double& t_hit) {
+    int nearest = -1;
+    double best = infinity;
+    for (int k = 0; k < lanes; k++) {
+        if (t[k] < best || (t[k] == best && t[k] < infinity && index[k] < nearest)) {
+            best = t[k];
+            nearest = int(index[k]);
+        }
+    }
+    t_hit = best;
+    return nearest;
+}
+
+// The SIMD kernels all compute, for W spheres at a time, the same roots as hit_sphere():
+// the smaller root if it lies inside ray_t, otherwise the larger one, otherwise infinity.
+// NaN padding spheres fail the discriminant test. Each lane keeps its own nearest hit.
+// Most spheres are missed by any given ray, so groups without a real root skip the
+// square root and the divisions.
+
+__attribute__((target("sse2")))
+int hit_spheres_sse2(const sphere_soa& s, const ray& r, interval ray_t, double& t_hit) {
+    const __m128d ox = _mm_set1_pd(r.origin().x()), oy = _mm_set1_pd(r.origin().y()), oz = _mm_set1_pd(r.origin().z());
+    const __m128d dx = _mm_set1_pd(r.direction().x()), dy = _mm_set1_pd(r.direction().y()), dz = _mm_set1_pd(r.direction().z());
+    const __m128d a = _mm_set1_pd(r.direction().length_squared());
+    const __m128d tmin = _mm_set1_pd(ray_t.min), tmax = _mm_set1_pd(ray_t.max);
+    const __m128d inf = _mm_set1_pd(infinity), zero = _mm_setzero_pd();
+    auto select = [](__m128d mask, __m128d x, __m128d y) {
+        return _mm_or_pd(_mm_and_pd(mask, x), _mm_andnot_pd(mask, y));
+    };
+
+    __m128d best = inf, best_index = _mm_set1_pd(-1), index = _mm_set_pd(1, 0);
+    for (size_t j = 0; j < s.cx.size(); j += 2) {
+        __m128d ocx = _mm_loadu_pd(&s.cx[j]) - ox;
+        __m128d ocy = _mm_loadu_pd(&s.cy[j]) - oy;
+        __m128d ocz = _mm_loadu_pd(&s.cz[j]) - oz;
+        __m128d rad = _mm_loadu_pd(&s.radius[j]);
+        __m128d h = dx*ocx + dy*ocy + dz*ocz;
+        __m128d c = ocx*ocx + ocy*ocy + ocz*ocz - rad*rad;
+        __m128d disc = h*h - a*c;
+        __m128d valid = _mm_cmpge_pd(disc, zero);
+        index = index + _mm_set1_pd(2);
+        if (_mm_movemask_pd(valid) == 0)
+            continue;
+        __m128d sqrtd = _mm_sqrt_pd(_mm_max_pd(disc, zero));
+        __m128d r1 = (h - sqrtd) / a;
+        __m128d r2 = (h + sqrtd) / a;
+        __m128d ok1 = _mm_and_pd(valid, _mm_and_pd(_mm_cmpgt_pd(r1, tmin), _mm_cmplt_pd(r1, tmax)));
+        __m128d ok2 = _mm_and_pd(valid, _mm_and_pd(_mm_cmpgt_pd(r2, tmin), _mm_cmplt_pd(r2, tmax)));
+        __m128d t = select(ok1, r1, select(ok2, r2, inf));
+        __m128d closer = _mm_cmplt_pd(t, best);
+        best = select(closer, t, best);
+        best_index = select(closer, index - _mm_set1_pd(2), best_index);
+    }
+    alignas(16) double t_lanes[2], index_lanes[2];
+    _mm_store_pd(t_lanes, best);
+    _mm_store_pd(index_lanes, best_index);
+    return reduce_lanes(t_lanes, index_lanes, 2, t_hit);
+}
+
+__attribute__((target("avx2,fma")))
+int hit_spheres_avx2(const sphere_soa& s, const ray& r, interval ray_t, double& t_hit) {
+    const __m256d ox = _mm256_set1_pd(r.origin().x()), oy = _mm256_set1_pd(r.origin().y()), oz = _mm256_set1_pd(r.origin().z());
+    const __m256d dx = _mm256_set1_pd(r.direction().x()), dy = _mm256_set1_pd(r.direction().y()), dz = _mm256_set1_pd(r.direction().z());
+    const __m256d a = _mm256_set1_pd(r.direction().length_squared());
+    const __m256d tmin = _mm256_set1_pd(ray_t.min), tmax = _mm256_set1_pd(ray_t.max);
+    const __m256d inf = _mm256_set1_pd(infinity), zero = _mm256_setzero_pd();
+
+    __m256d best = inf, best_index = _mm256_set1_pd(-1), index = _mm256_set_pd(3, 2, 1, 0);
+    for (size_t j = 0; j < s.cx.size(); j += 4) {
+        __m256d ocx = _mm256_loadu_pd(&s.cx[j]) - ox;
+        __m256d ocy = _mm256_loadu_pd(&s.cy[j]) - oy;
+        __m256d ocz = _mm256_loadu_pd(&s.cz[j]) - oz;
+        __m256d rad = _mm256_loadu_pd(&s.radius[j]);
+        __m256d h = _mm256_fmadd_pd(dx, ocx, _mm256_fmadd_pd(dy, ocy, dz*ocz));
+        __m256d c = _mm256_fmadd_pd(ocx, ocx, _mm256_fmadd_pd(ocy, ocy, _mm256_fmsub_pd(ocz, ocz, rad*rad)));
+        __m256d disc = _mm256_fmsub_pd(h, h, a*c);
+        __m256d valid = _mm256_cmp_pd(disc, zero, _CMP_GE_OQ);
+        index = index + _mm256_set1_pd(4);
+        if (_mm256_movemask_pd(valid) == 0)
+            continue;
+        __m256d sqrtd = _mm256_sqrt_pd(_mm256_max_pd(disc, zero));
+        __m256d r1 = (h - sqrtd) / a;
+        __m256d r2 = (h + sqrtd) / a;
+        __m256d ok1 = _mm256_and_pd(valid, _mm256_and_pd(_mm256_cmp_pd(r1, tmin, _CMP_GT_OQ), _mm256_cmp_pd(r1, tmax, _CMP_LT_OQ)));
+        __m256d ok2 = _mm256_and_pd(valid, _mm256_and_pd(_mm256_cmp_pd(r2, tmin, _CMP_GT_OQ), _mm256_cmp_pd(r2, tmax, _CMP_LT_OQ)));
+        __m256d t = _mm256_blendv_pd(_mm256_blendv_pd(inf, r2, ok2), r1, ok1);
+        __m256d closer = _mm256_cmp_pd(t, best, _CMP_LT_OQ);
+        best = _mm256_blendv_pd(best, t, closer);
+        best_index = _mm256_blendv_pd(best_index, index - _mm256_set1_pd(4), closer);
+    }
+    alignas(32) double t_lanes[4], index_lanes[4];
+    _mm256_store_pd(t_lanes, best);
+    _mm256_store_pd(index_lanes, best_index);
+    return reduce_lanes(t_lanes, index_lanes, 4, t_hit);
+}
+
+// GCC 12 warns about the deliberately undefined pass-through operand inside _mm512_sqrt_pd
+// and _mm512_max_pd.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+__attribute__((target("avx512f")))
+int hit_spheres_avx512(const sphere_soa& s, const ray& r, interval ray_t, double& t_hit) {
+    const __m512d ox = _mm512_set1_pd(r.origin().x()), oy = _mm512_set1_pd(r.origin().y()), oz = _mm512_set1_pd(r.origin().z());
+    const __m512d dx = _mm512_set1_pd(r.direction().x()), dy = _mm512_set1_pd(r.direction().y()), dz = _mm512_set1_pd(r.direction().z());
+    const __m512d a = _mm512_set1_pd(r.direction().length_squared());
+    const __m512d tmin = _mm512_set1_pd(ray_t.min), tmax = _mm512_set1_pd(ray_t.max);
+    const __m512d inf = _mm512_set1_pd(infinity), zero = _mm512_setzero_pd();
+
+    __m512d best = inf, best_index = _mm512_set1_pd(-1), index = _mm512_set_pd(7, 6, 5, 4, 3, 2, 1, 0);
+    for (size_t j = 0; j < s.cx.size(); j += 8) {
+        __m512d ocx = _mm512_loadu_pd(&s.cx[j]) - ox;
+        __m512d ocy = _mm512_loadu_pd(&s.cy[j]) - oy;
+        __m512d ocz = _mm512_loadu_pd(&s.cz[j]) - oz;
+        __m512d rad = _mm512_loadu_pd(&s.radius[j]);
+        __m512d h = _mm512_fmadd_pd(dx, ocx, _mm512_fmadd_pd(dy, ocy, dz*ocz));
+        __m512d c = _mm512_fmadd_pd(ocx, ocx, _mm512_fmadd_pd(ocy, ocy, _mm512_fmsub_pd(ocz, ocz, rad*rad)));
+        __m512d disc = _mm512_fmsub_pd(h, h, a*c);
+        __mmask8 valid = _mm512_cmp_pd_mask(disc, zero, _CMP_GE_OQ);
+        index = index + _mm512_set1_pd(8);
+        if (valid == 0)
+            continue;
+        __m512d sqrtd = _mm512_sqrt_pd(_mm512_max_pd(disc, zero));
+        __m512d r1 = (h - sqrtd) / a;
+        __m512d r2 = (h + sqrtd) / a;
+        __mmask8 ok1 = valid & _mm512_cmp_pd_mask(r1, tmin, _CMP_GT_OQ) & _mm512_cmp_pd_mask(r1, tmax, _CMP_LT_OQ);
+        __mmask8 ok2 = valid & _mm512_cmp_pd_mask(r2, tmin, _CMP_GT_OQ) & _mm512_cmp_pd_mask(r2, tmax, _CMP_LT_OQ);
+        __m512d t = _mm512_mask_blend_pd(ok1, _mm512_mask_blend_pd(ok2, inf, r2), r1);
+        __mmask8 closer = _mm512_cmp_pd_mask(t, best, _CMP_LT_OQ);
+        best = _mm512_mask_blend_pd(closer, best, t);
+        best_index = _mm512_mask_blend_pd(closer, best_index, index - _mm512_set1_pd(8));
+    }
+    alignas(64) double t_lanes[8], index_lanes[8];
+    _mm512_store_pd(t_lanes, best);
+    _mm512_store_pd(index_lanes, best_index);
+    return reduce_lanes(t_lanes, index_lanes, 8, t_hit);
+}
+#pragma GCC diagnostic pop
+#endif
+
+bool cpu_supports(simd_level level) {
+#ifdef RT_X86
+    // Also called during static initialisation, before the CPU model is otherwise set up.
+    __builtin_cpu_init();
+    switch (level) {
+        case simd_level::none: return true;
+        case simd_level::scalar: return true;
+        case simd_level::sse2: return __builtin_cpu_supports("sse2");
+        case simd_level::avx2: return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+        case simd_level::avx512: return __builtin_cpu_supports("avx512f");
+    }
+    return false;
+#else
+    return level == simd_level::none || level == simd_level::scalar;
+#endif
+}
+
+hit_spheres_fn kernel_for(simd_level level) {
+#ifdef RT_X86
+    switch (level) {
+        case simd_level::none: return hit_spheres_scalar;
+        case simd_level::scalar: return hit_spheres_scalar;
+        case simd_level::sse2: return hit_spheres_sse2;
+        case simd_level::avx2: return hit_spheres_avx2;
+        case simd_level::avx512: return hit_spheres_avx512;
+    }
+#endif
+    return hit_spheres_scalar;
+}
+
+simd_level current_level = best_simd_level();
+hit_spheres_fn current_kernel = kernel_for(current_level);
+}
+
+const char* simd_level_name(simd_level level) {
+    switch (level) {
+        case simd_level::none: return "none";
+        case simd_level::scalar: return "scalar";
+        case simd_level::sse2: return "sse2";
+        case simd_level::avx2: return "avx2";
+        case simd_level::avx512: return "avx512";
+    }
+    return "unknown";
+}
+
+bool parse_simd_level(const std::string& name, simd_level& level) {
+    if (name == "none") level = simd_level::none;
+    else if (name == "scalar") level = simd_level::scalar;
+    else if (name == "sse2") level = simd_level::sse2;
+    else if (name == "avx2") level = simd_level::avx2;
+    else if (name == "avx512") level = simd_level::avx512;
+    else return false;
+    return true;
+}
+
+simd_level best_simd_level() {
+    for (simd_level level : {simd_level::avx512, simd_level::avx2, simd_level::sse2})
+        if (cpu_supports(level))
+            return level;
+    return simd_level::scalar;
+}
+
+simd_level active_simd_level() {
+    return current_level;
+}
+
+bool set_simd_level(simd_level level) {
+    if (!cpu_supports(level))
+        return false;
+    current_level = level;
+    current_kernel = kernel_for(level);
+    return true;
+}
+
+int hit_spheres(const sphere_soa& spheres, const ray& r, interval ray_t, double& t_hit) {
+    return current_kernel(spheres, r, ray_t, t_hit);
+}
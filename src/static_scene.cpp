@@ -0,0 +1,54 @@
+#include "static_scene.h"
+
+bool static_scene::build(const hittable_list& world) {
+    materials.clear();
+    primitives.clear();
+    spheres.clear();
+    sphere_primitive_index.clear();
+    variant_primitives.clear();
+    use_sphere_kernel = active_simd_level() != simd_level::none;
+    // Materials shared by several objects (e.g. through one shared_ptr) are stored once.
+    std::vector<std::pair<const material*, int>> material_ids;
+    return add(world, material_ids);
+}
+
+bool static_scene::add(const hittable& object, std::vector<std::pair<const material*, int>>& material_ids) {
+    if (auto list = dynamic_cast<const hittable_list*>(&object)) {
+        for (const auto& child : list->objects)
+            if (!add(*child, material_ids))
+                return false;
+        return true;
+    }
+
+    auto s = dynamic_cast<const sphere*>(&object);
+    if (s == nullptr)
+        return false;
+
+    const material* m = s->mat.get();
+    int id = -1;
+    for (const auto& entry : material_ids)
+        if (entry.first == m)
+            id = entry.second;
+    if (id < 0) {
+        if (auto l = dynamic_cast<const lambertian*>(m)) materials.emplace_back(*l);
+        else if (auto me = dynamic_cast<const metal*>(m)) materials.emplace_back(*me);
+        else if (auto d = dynamic_cast<const dielectric*>(m)) materials.emplace_back(*d);
+        else return false;
+        id = int(materials.size()) - 1;
+        material_ids.emplace_back(m, id);
+    }
+    add_primitive(sphere_primitive(s->center, s->radius, id));
+    return true;
+}
+
+void static_scene::add_primitive(const primitive_variant& primitive) {
+    int index = int(primitives.size());
+    primitives.push_back(primitive);
+    auto s = std::get_if<sphere_primitive>(&primitive);
+    if (s != nullptr && use_sphere_kernel) {
+        spheres.add(s->center, s->radius);
+        sphere_primitive_index.push_back(index);
+    } else {
+        variant_primitives.push_back(index);
+    }
+}
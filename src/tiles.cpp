@@ -0,0 +1,91 @@
+#include "tiles.h"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace {
+// Spreads the lower 32 bits of x so that there is a zero bit between each of them.
+uint64_t part_by_1(uint64_t x) {
+    x &= 0x00000000ffffffffULL;
+    x = (x | (x << 16)) & 0x0000ffff0000ffffULL;
+    x = (x | (x << 8))  & 0x00ff00ff00ff00ffULL;
+    x = (x | (x << 4))  & 0x0f0f0f0f0f0f0f0fULL;
+    x = (x | (x << 2))  & 0x3333333333333333ULL;
+    x = (x | (x << 1))  & 0x5555555555555555ULL;
+    return x;
+}
+
+uint64_t morton_code(int x, int y) {
+    return part_by_1(uint64_t(x)) | (part_by_1(uint64_t(y)) << 1);
+}
+}
+
+bool parse_tile_order(const std::string& name, tile_order& order) {
+    if (name == "raster") order = tile_order::raster;
+    else if (name == "morton") order = tile_order::morton;
+    else if (name == "spiral") order = tile_order::spiral;
+    else return false;
+    return true;
+}
+
+const char* tile_order_name(tile_order order) {
+    switch (order) {
+        case tile_order::raster: return "raster";
+        case tile_order::morton: return "morton";
+        case tile_order::spiral: return "spiral";
+    }
+    return "unknown";
+}
+
+std::vector<std::pair<int, int>> generate_tiles(int tiles_x, int tiles_y, tile_order order) {
+    std::vector<std::pair<int, int>> tiles;
+    if (tiles_x <= 0 || tiles_y <= 0)
+        return tiles;
+    const size_t total = size_t(tiles_x) * size_t(tiles_y);
+    tiles.reserve(total);
+
+    switch (order) {
+        case tile_order::raster:
+            for (int j = 0; j < tiles_y; j++)
+                for (int i = 0; i < tiles_x; i++)
+                    tiles.emplace_back(i, j);
+            break;
+
+        case tile_order::morton:
+            // The grid is generally not a power of two square, so instead of walking
+            // the curve we sort the tiles by their Morton code, which skips the holes.
+            for (int j = 0; j < tiles_y; j++)
+                for (int i = 0; i < tiles_x; i++)
+                    tiles.emplace_back(i, j);
+            std::sort(tiles.begin(), tiles.end(), [](const auto& a, const auto& b) {
+                return morton_code(a.first, a.second) < morton_code(b.first, b.second);
+            });
+            break;
+
+        case tile_order::spiral: {
+            // Walk right, down, left, up with run lengths 1, 1, 2, 2, 3, 3, ...
+            // and keep the positions that fall inside the grid.
+            const int dx[4] = {1, 0, -1, 0};
+            const int dy[4] = {0, 1, 0, -1};
+            int x = (tiles_x - 1) / 2;
+            int y = (tiles_y - 1) / 2;
+            int dir = 0;
+            int run = 1;
+            tiles.emplace_back(x, y);
+            while (tiles.size() < total) {
+                for (int leg = 0; leg < 2 && tiles.size() < total; leg++) {
+                    for (int step = 0; step < run; step++) {
+                        x += dx[dir];
+                        y += dy[dir];
+                        if (x >= 0 && x < tiles_x && y >= 0 && y < tiles_y)
+                            tiles.emplace_back(x, y);
+                    }
+                    dir = (dir + 1) % 4;
+                }
+                run++;
+            }
+            break;
+        }
+    }
+    return tiles;
+}
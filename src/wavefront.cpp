@@ -0,0 +1,175 @@
+#include "wavefront.h"
+
+#include <algorithm>
+#include <iomanip>
+
+void ray_queue::clear() {
+    resize(0);
+}
+
+void ray_queue::reserve(size_t n) {
+    for (auto* v : {&ox, &oy, &oz, &dx, &dy, &dz, &tr, &tg, &tb})
+        v->reserve(n);
+    pixel.reserve(n);
+}
+
+void ray_queue::resize(size_t n) {
+    for (auto* v : {&ox, &oy, &oz, &dx, &dy, &dz, &tr, &tg, &tb})
+        v->resize(n);
+    pixel.resize(n);
+}
+
+void ray_queue::push(const ray& r, const color& throughput, int pix) {
+    ox.push_back(r.origin().x()); oy.push_back(r.origin().y()); oz.push_back(r.origin().z());
+    dx.push_back(r.direction().x()); dy.push_back(r.direction().y()); dz.push_back(r.direction().z());
+    tr.push_back(throughput.x()); tg.push_back(throughput.y()); tb.push_back(throughput.z());
+    pixel.push_back(pix);
+}
+
+void ray_queue::set(size_t k, const ray& r, const color& throughput) {
+    ox[k] = r.origin().x(); oy[k] = r.origin().y(); oz[k] = r.origin().z();
+    dx[k] = r.direction().x(); dy[k] = r.direction().y(); dz[k] = r.direction().z();
+    tr[k] = throughput.x(); tg[k] = throughput.y(); tb[k] = throughput.z();
+}
+
+void ray_queue::move(size_t from, size_t to) {
+    for (auto* v : {&ox, &oy, &oz, &dx, &dy, &dz, &tr, &tg, &tb})
+        (*v)[to] = (*v)[from];
+    pixel[to] = pixel[from];
+}
+
+void wavefront_stats::merge(const wavefront_stats& other) {
+    generate_seconds += other.generate_seconds;
+    intersect_seconds += other.intersect_seconds;
+    shade_seconds += other.shade_seconds;
+    compact_seconds += other.compact_seconds;
+    if (active_rays.size() < other.active_rays.size())
+        active_rays.resize(other.active_rays.size());
+    for (size_t b = 0; b < other.active_rays.size(); b++)
+        active_rays[b] += other.active_rays[b];
+}
+
+void wavefront_stats::print(std::ostream& out) const {
+    out << "Wavefront stage times (thread-seconds):"
+        << "\n  generate  " << generate_seconds
+        << "\n  intersect " << intersect_seconds
+        << "\n  shade     " << shade_seconds
+        << "\n  compact   " << compact_seconds
+        << "\nActive rays per bounce:";
+    for (size_t b = 0; b < active_rays.size(); b++) {
+        out << "\n  " << std::setw(2) << b << ' ' << active_rays[b];
+        if (b > 0 && active_rays[0] > 0)
+            out << " (" << 100.0 * active_rays[b] / active_rays[0] << "%)";
+    }
+    out << '\n';
+}
+
+void wavefront_integrator::render(std::vector<color>& data, const int sub_x, const int sub_y, wavefront_stats& stats) {
+    const tile_rect tile = cam.tile_bounds(sub_x, sub_y);
+    const int start_x = tile.start_x, start_y = tile.start_y;
+    const int tile_w = tile.end_x - start_x;
+    const long long pixels = (long long)tile_w * (tile.end_y - start_y);
+    const long long total_paths = pixels * cam.samples_per_pixel;
+
+    sum.assign(pixels, color(0, 0, 0));
+    queue.reserve(std::min<long long>(batch_size, total_paths));
+    if (stats.active_rays.size() < size_t(cam.max_depth))
+        stats.active_rays.resize(cam.max_depth);
+
+    // Path p traces sample p / pixels of pixel p % pixels, so every batch spreads over the tile.
+    for (long long first = 0; first < total_paths; first += batch_size) {
+        long long last = std::min(first + batch_size, total_paths);
+
+        auto stage_start = std::chrono::steady_clock::now();
+        queue.clear();
+        for (long long p = first; p < last; p++) {
+            int k = int(p % pixels);
+            queue.push(cam.get_ray(start_x + k % tile_w, start_y + k / tile_w), color(1, 1, 1), k);
+        }
+        stats.generate_seconds += seconds_since(stage_start);
+
+        for (int bounce = 0; bounce < cam.max_depth && queue.size() > 0; bounce++) {
+            stats.active_rays[bounce] += queue.size();
+            intersect(stats);
+            shade(stats);
+            compact(stats);
+        }
+    }
+
+    for (long long k = 0; k < pixels; k++)
+        data[size_t(start_y + k / tile_w)*cam.image_width + start_x + k % tile_w] = sum[k]*cam.pixel_samples_scale;
+}
+
+void wavefront_integrator::intersect(wavefront_stats& stats) {
+    auto start = std::chrono::steady_clock::now();
+    const size_t n = queue.size();
+    for (auto* v : {&hit_px, &hit_py, &hit_pz, &hit_nx, &hit_ny, &hit_nz})
+        v->resize(n);
+    hit_front.resize(n);
+    hit_mat.resize(n);
+
+    for (size_t k = 0; k < n; k++) {
+        ray r = queue.get_ray(k);
+        static_hit_record rec;
+        if (world.hit(r, interval(0.0001, infinity), rec)) {
+            hit_px[k] = rec.p.x(); hit_py[k] = rec.p.y(); hit_pz[k] = rec.p.z();
+            hit_nx[k] = rec.normal.x(); hit_ny[k] = rec.normal.y(); hit_nz[k] = rec.normal.z();
+            hit_front[k] = rec.front_face;
+            hit_mat[k] = rec.mat;
+        } else {
+            // Misses pick up the sky colour and end here.
+            hit_mat[k] = -1;
+            sum[queue.pixel[k]] += queue.throughput(k) * cam.background(r);
+        }
+    }
+    stats.intersect_seconds += seconds_since(start);
+}
+
+void wavefront_integrator::shade(wavefront_stats& stats) {
+    auto start = std::chrono::steady_clock::now();
+    const size_t n = queue.size();
+
+    // Counting sort of the hits by material kind, so that each scatter kernel runs over
+    // one contiguous group of rays.
+    int counts[static_scene::material_kinds + 1] = {};
+    for (size_t k = 0; k < n; k++)
+        if (hit_mat[k] >= 0)
+            counts[world.material_kind(hit_mat[k]) + 1]++;
+    for (int m = 0; m < static_scene::material_kinds; m++)
+        counts[m + 1] += counts[m];
+    order.resize(counts[static_scene::material_kinds]);
+    for (size_t k = 0; k < n; k++)
+        if (hit_mat[k] >= 0)
+            order[counts[world.material_kind(hit_mat[k])]++] = int(k);
+
+    alive.assign(n, 0);
+    for (int k : order) {
+        static_hit_record rec;
+        rec.p = point3(hit_px[k], hit_py[k], hit_pz[k]);
+        rec.normal = vec3(hit_nx[k], hit_ny[k], hit_nz[k]);
+        rec.front_face = hit_front[k];
+        rec.mat = hit_mat[k];
+        ray scattered;
+        color attenuation;
+        if (world.scatter(queue.get_ray(k), rec, attenuation, scattered)) {
+            queue.set(k, scattered, queue.throughput(k) * attenuation);
+            alive[k] = 1;
+        }
+    }
+    stats.shade_seconds += seconds_since(start);
+}
+
+void wavefront_integrator::compact(wavefront_stats& stats) {
+    auto start = std::chrono::steady_clock::now();
+    // Stable in place compaction of the surviving paths, which form the next bounce.
+    size_t survivors = 0;
+    for (size_t k = 0; k < queue.size(); k++) {
+        if (alive[k]) {
+            if (k != survivors)
+                queue.move(k, survivors);
+            survivors++;
+        }
+    }
+    queue.resize(survivors);
+    stats.compact_seconds += seconds_since(start);
+}
@@ -0,0 +1,81 @@
+// Terminal viewer for the progressive preview written by `ray_tracer --preview`.
+// Polls the preview file and redraws it with 24-bit ANSI colours whenever it changes,
+// packing two image rows into one character cell using the upper half block.
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct image {
+    int width = 0, height = 0;
+    std::vector<unsigned char> rgb;
+};
+
+bool read_ppm(const std::string& path, image& img) {
+    std::ifstream in(path, std::ios::in | std::ios::binary);
+    std::string magic;
+    int maxval;
+    if (!(in >> magic >> img.width >> img.height >> maxval) || magic != "P6" || maxval != 255)
+        return false;
+    in.get(); // Single whitespace before the pixel data
+    img.rgb.resize(size_t(img.width) * img.height * 3);
+    in.read(reinterpret_cast<char*>(img.rgb.data()), img.rgb.size());
+    return bool(in);
+}
+
+void draw(const image& img, int columns) {
+    // Nearest neighbour downsampling to the requested terminal width.
+    int rows = std::max(1, int(double(img.height) / img.width * columns));
+    auto pixel = [&](int c, int r) {
+        size_t x = size_t(c) * img.width / columns;
+        size_t y = size_t(r) * img.height / rows;
+        return &img.rgb[(y * img.width + x) * 3];
+    };
+    std::string out = "\x1b[H";
+    for (int r = 0; r + 1 < rows; r += 2) {
+        for (int c = 0; c < columns; c++) {
+            const unsigned char* top = pixel(c, r);
+            const unsigned char* bottom = pixel(c, r + 1);
+            out += "\x1b[38;2;" + std::to_string(top[0]) + ';' + std::to_string(top[1]) + ';' + std::to_string(top[2]) + 'm';
+            out += "\x1b[48;2;" + std::to_string(bottom[0]) + ';' + std::to_string(bottom[1]) + ';' + std::to_string(bottom[2]) + 'm';
+            out += "▀";
+        }
+        out += "\x1b[0m\n";
+    }
+    std::cout << out << std::flush;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 3) {
+        std::cout << "Usage: ./preview_viewer [FILE] [COLUMNS]" << std::endl;
+        return 1;
+    }
+    std::string path = (argc > 1) ? argv[1] : "preview.ppm";
+    int columns = (argc > 2) ? std::stoi(argv[2]) : 80;
+
+    std::cout << "\x1b[2J";
+    std::filesystem::file_time_type last_change{};
+    int frames = 0;
+    auto start = std::chrono::steady_clock::now();
+    while (true) {
+        std::error_code ec;
+        auto changed = std::filesystem::last_write_time(path, ec);
+        if (!ec && changed != last_change) {
+            image img;
+            // The renderer replaces the file atomically, so a failed read just means it was removed.
+            if (read_ppm(path, img)) {
+                last_change = changed;
+                draw(img, columns);
+                frames++;
+                double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                std::cout << path << "  " << img.width << 'x' << img.height
+                          << "  frame " << frames << "  " << elapsed << " s" << "\x1b[K" << std::endl;
+            }
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+}